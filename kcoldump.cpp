@@ -0,0 +1,54 @@
+/**
+ *  @file     kcoldump.cpp
+ *  @version  1.0
+ *
+ *  @brief    This program prints the boots and services of a
+ *  .kcol file written by ps4b, one row per line, separated
+ *  by tabs. It is also a small example of using ColumnarReader.
+ * */
+#include <iostream>
+#include <string>
+#include "kronos_columnar.hpp"
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "kcoldump [file name]" << std::endl;
+        return -1;
+    }
+
+    ColumnarReader reader(argv[1]);
+    if (!reader.isOpen()) {
+        std::cout << "kcoldump: " << argv[1] << " is not a valid .kcol file"
+                  << std::endl;
+        return -1;
+    }
+
+    // Boot rows
+    const uint32_t *device = reader.bootDevice();
+    const int32_t *start_line = reader.bootStartLine();
+    const int32_t *end_line = reader.bootEndLine();
+    const int64_t *start_time = reader.bootStartTime();
+    const int64_t *end_time = reader.bootEndTime();
+    const int64_t *duration = reader.bootDurationMs();
+    std::cout << "boot\tdevice\tstart_line\tend_line\tstart_time_ms"
+              << "\tend_time_ms\tduration_ms" << std::endl;
+    for (std::size_t b = 0; b < reader.bootCount(); ++b)
+        std::cout << b << '\t' << reader.dictString(device[b]) << '\t'
+                  << start_line[b] << '\t' << end_line[b] << '\t'
+                  << start_time[b] << '\t' << end_time[b] << '\t'
+                  << duration[b] << std::endl;
+
+    // Service rows
+    const uint32_t *boot = reader.serviceBoot();
+    const uint32_t *id = reader.serviceId();
+    const int32_t *s_start_line = reader.serviceStartLine();
+    const int32_t *s_end_line = reader.serviceEndLine();
+    const int64_t *s_duration = reader.serviceDurationMs();
+    std::cout << std::endl << "boot\tservice\tstart_line\tend_line"
+              << "\tduration_ms" << std::endl;
+    for (std::size_t s = 0; s < reader.serviceCount(); ++s)
+        std::cout << boot[s] << '\t' << reader.dictString(id[s]) << '\t'
+                  << s_start_line[s] << '\t' << s_end_line[s] << '\t'
+                  << s_duration[s] << std::endl;
+    return 0;
+}
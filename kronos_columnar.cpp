@@ -0,0 +1,258 @@
+/**
+ *  @file     kronos_columnar.cpp
+ *  @version  1.0
+ *
+ *  @brief    This is the implementation of the binary
+ *  columnar export and of its reader.
+ * */
+#include "kronos_columnar.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+const std::size_t ALIGNMENT = 8;  // Every column starts on this boundary
+
+// Size in bytes of one value of each column, 1 for the string data
+const std::size_t COLUMN_WIDTH[COL_COUNT] = {
+  4, 4, 4, 8, 8, 8,   // Boot columns
+  4, 4, 4, 4, 8,      // Service columns
+  8, 1                // Dictionary
+};
+
+std::size_t align(std::size_t offset) {
+  return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// The log time has no timezone, so this is the naive local time
+int64_t toEpochMs(boost::posix_time::ptime time) {
+  if (time.is_not_a_date_time()) return COLUMNAR_NO_TIME;
+  boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+  return (time - epoch).total_milliseconds();
+}
+
+// Give back the dictionary id of a string, adding it if it is new
+uint32_t intern(const std::string &value,
+                std::map<std::string, uint32_t> &ids,
+                std::vector<std::string> &strings) {
+  std::map<std::string, uint32_t>::iterator it = ids.find(value);
+  if (it != ids.end()) return it->second;
+  uint32_t id = static_cast<uint32_t>(strings.size());
+  ids.insert(std::pair<std::string, uint32_t>(value, id));
+  strings.push_back(value);
+  return id;
+}
+
+void pad(std::ofstream &out, std::size_t written) {
+  static const char zeros[ALIGNMENT] = {0};
+  out.write(zeros, align(written) - written);
+}
+
+// Write the values of one column and pad it to the next boundary
+template <typename T>
+void writeColumn(std::ofstream &out, const std::vector<T> &values) {
+  if (!values.empty())
+    out.write(reinterpret_cast<const char*>(&values[0]),
+              values.size() * sizeof(T));
+  pad(out, values.size() * sizeof(T));
+}
+}  // namespace
+
+bool writeColumnar(std::string file_name, std::vector<Boot> &boots) {
+  std::map<std::string, uint32_t> ids;
+  std::vector<std::string> strings;
+  std::vector<uint32_t> boot_device, service_boot, service_id;
+  std::vector<int32_t> boot_start_line, boot_end_line;
+  std::vector<int32_t> service_start_line, service_end_line;
+  std::vector<int64_t> boot_start_time, boot_end_time, boot_duration;
+  std::vector<int64_t> service_duration;
+
+  // Split every boot and its services into the columns
+  for (std::size_t b = 0; b < boots.size(); ++b) {
+    Boot &boot = boots[b];
+    bool ended = !boot.getEndTime().is_not_a_date_time();
+    boot_device.push_back(intern(boot.getFileName(), ids, strings));
+    boot_start_line.push_back(boot.getStartLine());
+    boot_end_line.push_back(ended ? boot.getEndLine() : -1);
+    boot_start_time.push_back(toEpochMs(boot.getStartTime()));
+    boot_end_time.push_back(toEpochMs(boot.getEndTime()));
+    boot_duration.push_back(
+        ended ? boot.getDuration().total_milliseconds() : -1);
+
+    std::map<std::string, Service>::iterator it = boot.begin();
+    for (; it != boot.end(); ++it) {
+      const Service &service = (*it).second;
+      service_boot.push_back(static_cast<uint32_t>(b));
+      service_id.push_back(intern(service.getName(), ids, strings));
+      service_start_line.push_back(
+          service.isStarted() ? service.getStartLine() : -1);
+      service_end_line.push_back(
+          service.isComplete() ? service.getEndLine() : -1);
+      service_duration.push_back(
+          service.isComplete() ? service.getDurationMs() : -1);
+    }
+  }
+
+  // The dictionary is a list of offsets into one block of text
+  std::vector<uint64_t> dict_offsets;
+  std::string dict_data;
+  for (std::size_t k = 0; k < strings.size(); ++k) {
+    dict_offsets.push_back(dict_data.size());
+    dict_data += strings[k];
+  }
+  dict_offsets.push_back(dict_data.size());
+
+  // Fill the header and work out where each column goes
+  ColumnarHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+  header.version = COLUMNAR_VERSION;
+  header.endian_tag = COLUMNAR_ENDIAN_TAG;
+  header.boot_count = boots.size();
+  header.service_count = service_boot.size();
+  header.dict_count = strings.size();
+
+  std::size_t rows[COL_COUNT] = {
+    boots.size(), boots.size(), boots.size(),
+    boots.size(), boots.size(), boots.size(),
+    service_boot.size(), service_boot.size(), service_boot.size(),
+    service_boot.size(), service_boot.size(),
+    dict_offsets.size(), dict_data.size()
+  };
+  std::size_t offset = align(sizeof(header));
+  for (int c = 0; c < COL_COUNT; ++c) {
+    header.offset[c] = offset;
+    offset = align(offset + rows[c] * COLUMN_WIDTH[c]);
+  }
+
+  std::ofstream out(file_name.c_str(), std::ios::binary);
+  if (!out) return false;
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  pad(out, sizeof(header));
+  writeColumn(out, boot_device);
+  writeColumn(out, boot_start_line);
+  writeColumn(out, boot_end_line);
+  writeColumn(out, boot_start_time);
+  writeColumn(out, boot_end_time);
+  writeColumn(out, boot_duration);
+  writeColumn(out, service_boot);
+  writeColumn(out, service_id);
+  writeColumn(out, service_start_line);
+  writeColumn(out, service_end_line);
+  writeColumn(out, service_duration);
+  writeColumn(out, dict_offsets);
+  out.write(dict_data.data(), dict_data.size());
+  pad(out, dict_data.size());
+  out.close();
+  return !out.fail();
+}
+
+ColumnarReader::ColumnarReader(std::string file_name) :
+    data_(NULL), size_(0), header_(NULL) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      data_ = static_cast<const char*>(map);
+      size_ = info.st_size;
+    }
+  }
+  close(fd);  // The mapping stays valid after the close
+  if (data_ == NULL) return;
+  header_ = reinterpret_cast<const ColumnarHeader*>(data_);
+  if (!validate()) header_ = NULL;  // Keep the map, but report not open
+}
+ColumnarReader::~ColumnarReader() {
+  if (data_ != NULL) munmap(const_cast<char*>(data_), size_);
+}
+bool ColumnarReader::validate() const {
+  if (size_ < sizeof(ColumnarHeader)) return false;
+  if (std::memcmp(header_->magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC)))
+    return false;
+  if (header_->version != COLUMNAR_VERSION ||
+      header_->endian_tag != COLUMNAR_ENDIAN_TAG)
+    return false;
+  if (header_->dict_count >= size_) return false;  // Can not be that many
+  // Check that every column is aligned and inside the file
+  for (int c = 0; c < COL_COUNT; ++c) {
+    uint64_t rows = c <= COL_BOOT_DURATION_MS ? header_->boot_count
+                  : c <= COL_SERVICE_DURATION_MS ? header_->service_count
+                  : c == COL_DICT_OFFSETS ? header_->dict_count + 1
+                  : 0;  // Data size is checked with the offsets below
+    uint64_t start = header_->offset[c];
+    if (start % ALIGNMENT != 0 || start > size_) return false;
+    if (rows > (size_ - start) / COLUMN_WIDTH[c]) return false;
+  }
+  // The last dictionary offset is the size of the string data
+  const uint64_t *offsets =
+      reinterpret_cast<const uint64_t*>(column(COL_DICT_OFFSETS));
+  uint64_t data_size = offsets[header_->dict_count];
+  if (data_size > size_ - header_->offset[COL_DICT_DATA]) return false;
+  for (uint64_t k = 0; k < header_->dict_count; ++k)
+    if (offsets[k] > offsets[k + 1]) return false;
+  return true;
+}
+bool ColumnarReader::isOpen() const {
+  return header_ != NULL;
+}
+const char* ColumnarReader::column(ColumnId column) const {
+  if (header_ == NULL) return NULL;  // Not open, no columns
+  return data_ + header_->offset[column];
+}
+std::size_t ColumnarReader::bootCount() const {
+  return header_ ? header_->boot_count : 0;
+}
+std::size_t ColumnarReader::serviceCount() const {
+  return header_ ? header_->service_count : 0;
+}
+std::size_t ColumnarReader::dictCount() const {
+  return header_ ? header_->dict_count : 0;
+}
+std::string ColumnarReader::dictString(uint32_t id) const {
+  if (id >= dictCount()) return "";  // Unknown id or not open
+  const uint64_t *offsets =
+      reinterpret_cast<const uint64_t*>(column(COL_DICT_OFFSETS));
+  const char *text = column(COL_DICT_DATA);
+  return std::string(text + offsets[id], offsets[id + 1] - offsets[id]);
+}
+const uint32_t* ColumnarReader::bootDevice() const {
+  return reinterpret_cast<const uint32_t*>(column(COL_BOOT_DEVICE));
+}
+const int32_t* ColumnarReader::bootStartLine() const {
+  return reinterpret_cast<const int32_t*>(column(COL_BOOT_START_LINE));
+}
+const int32_t* ColumnarReader::bootEndLine() const {
+  return reinterpret_cast<const int32_t*>(column(COL_BOOT_END_LINE));
+}
+const int64_t* ColumnarReader::bootStartTime() const {
+  return reinterpret_cast<const int64_t*>(column(COL_BOOT_START_TIME));
+}
+const int64_t* ColumnarReader::bootEndTime() const {
+  return reinterpret_cast<const int64_t*>(column(COL_BOOT_END_TIME));
+}
+const int64_t* ColumnarReader::bootDurationMs() const {
+  return reinterpret_cast<const int64_t*>(column(COL_BOOT_DURATION_MS));
+}
+const uint32_t* ColumnarReader::serviceBoot() const {
+  return reinterpret_cast<const uint32_t*>(column(COL_SERVICE_BOOT));
+}
+const uint32_t* ColumnarReader::serviceId() const {
+  return reinterpret_cast<const uint32_t*>(column(COL_SERVICE_ID));
+}
+const int32_t* ColumnarReader::serviceStartLine() const {
+  return reinterpret_cast<const int32_t*>(column(COL_SERVICE_START_LINE));
+}
+const int32_t* ColumnarReader::serviceEndLine() const {
+  return reinterpret_cast<const int32_t*>(column(COL_SERVICE_END_LINE));
+}
+const int64_t* ColumnarReader::serviceDurationMs() const {
+  return reinterpret_cast<const int64_t*>(column(COL_SERVICE_DURATION_MS));
+}
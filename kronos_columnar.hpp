@@ -0,0 +1,202 @@
+/**
+ *  @file     kronos_columnar.hpp
+ *  @version  1.0
+ *
+ *  @brief    This is the interface of the binary columnar
+ *  export of the boots and services, and of a small reader
+ *  that maps the file in memory and reads it without copies.
+ *
+ *  File layout (.kcol). Numbers are in host byte order and the
+ *  header has an endian tag, so a file from a big-endian host
+ *  is rejected instead of read wrong.
+ *
+ *    Header (ColumnarHeader below, 8-byte aligned)
+ *      char     magic[8]        "KRONCOL1"
+ *      uint32   version         COLUMNAR_VERSION
+ *      uint32   endian_tag      COLUMNAR_ENDIAN_TAG
+ *      uint64   boot_count
+ *      uint64   service_count
+ *      uint64   dict_count      Number of strings in the dictionary
+ *      uint64   offset[COL_COUNT]  Byte offset of each column
+ *
+ *    Columns, each one starts on an 8 byte boundary
+ *      Boot rows (boot_count values each)
+ *        COL_BOOT_DEVICE       uint32  Dictionary id of the log file
+ *        COL_BOOT_START_LINE   int32   Line of the boot start
+ *        COL_BOOT_END_LINE     int32   Line of the boot end, -1 if none
+ *        COL_BOOT_START_TIME   int64   ms since 1970-01-01 (see below)
+ *        COL_BOOT_END_TIME     int64   Same as start time,
+ *                                      COLUMNAR_NO_TIME if none
+ *        COL_BOOT_DURATION_MS  int64   -1 if the boot did not end
+ *      Service rows (service_count values each)
+ *        COL_SERVICE_BOOT        uint32  Row of the boot it belongs to
+ *        COL_SERVICE_ID          uint32  Dictionary id of the name
+ *        COL_SERVICE_START_LINE  int32   -1 if not started
+ *        COL_SERVICE_END_LINE    int32   -1 if not completed
+ *        COL_SERVICE_DURATION_MS int64   -1 if not completed, or if
+ *                                        the logged value is too big
+ *                                        (end line is set then)
+ *      Dictionary
+ *        COL_DICT_OFFSETS  uint64[dict_count + 1]  Start of each string
+ *        COL_DICT_DATA     char[]  All the strings, no terminators.
+ *                          String k is [offsets[k], offsets[k + 1]).
+ *
+ *  The times are the device's local wall clock times from the log,
+ *  which has no timezone. They are stored as if that clock was UTC,
+ *  so they are naive local times and should not be shifted by a
+ *  timezone when read back. A missing time is COLUMNAR_NO_TIME
+ *  (INT64_MIN), because -1 is a valid time.
+ * */
+#ifndef PS4_KRONOS_COLUMNAR_HPP
+#define PS4_KRONOS_COLUMNAR_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+#include "kronos_parse_class.hpp"
+
+const char COLUMNAR_MAGIC[8] = {'K', 'R', 'O', 'N', 'C', 'O', 'L', '1'};
+const uint32_t COLUMNAR_VERSION = 2;
+const uint32_t COLUMNAR_ENDIAN_TAG = 0x01020304;
+const int64_t COLUMNAR_NO_TIME = std::numeric_limits<int64_t>::min();
+
+enum ColumnId {
+  COL_BOOT_DEVICE,
+  COL_BOOT_START_LINE,
+  COL_BOOT_END_LINE,
+  COL_BOOT_START_TIME,
+  COL_BOOT_END_TIME,
+  COL_BOOT_DURATION_MS,
+  COL_SERVICE_BOOT,
+  COL_SERVICE_ID,
+  COL_SERVICE_START_LINE,
+  COL_SERVICE_END_LINE,
+  COL_SERVICE_DURATION_MS,
+  COL_DICT_OFFSETS,
+  COL_DICT_DATA,
+  COL_COUNT
+};
+
+struct ColumnarHeader {
+  char magic[8];                //  < Always COLUMNAR_MAGIC
+  uint32_t version;             //  < Always COLUMNAR_VERSION
+  uint32_t endian_tag;          //  < Always COLUMNAR_ENDIAN_TAG
+  uint64_t boot_count;          //  < Number of boot rows
+  uint64_t service_count;       //  < Number of service rows
+  uint64_t dict_count;          //  < Number of dictionary strings
+  uint64_t offset[COL_COUNT];   //  < Byte offset of each column
+};
+
+/**
+ *  @brief  Write the boots and all their services to a file
+ *  in the columnar layout described above.
+ *
+ *  @param  std::string file_name, std::vector<Boot>& boots
+ *
+ *  @return bool, false if the file could not be written
+ * */
+bool writeColumnar(std::string file_name, std::vector<Boot> &boots);
+
+class ColumnarReader {
+ public:
+  /**
+   *  @brief  Constructor of the reader. It maps the file in
+   *  memory and checks the header. Use isOpen() to know if
+   *  it worked.
+   *
+   *  @param  std::string file_name
+   * */
+  explicit ColumnarReader(std::string file_name);
+  /**
+   *  @brief  Destructor, unmaps the file
+   * */
+  ~ColumnarReader();
+  /**
+   *  @brief  True if the file was mapped and is a valid export
+   *
+   *  @return bool
+   * */
+  bool isOpen() const;
+  /**
+   *  @brief  Getter for the number of boot rows, 0 if not open
+   *
+   *  @return std::size_t
+   * */
+  std::size_t bootCount() const;
+  /**
+   *  @brief  Getter for the number of service rows, 0 if not open
+   *
+   *  @return std::size_t
+   * */
+  std::size_t serviceCount() const;
+  /**
+   *  @brief  Getter for the number of dictionary strings,
+   *  0 if not open
+   *
+   *  @return std::size_t
+   * */
+  std::size_t dictCount() const;
+  /**
+   *  @brief  Get a string of the dictionary by its id. It is
+   *  empty if the id is unknown or the reader is not open.
+   *
+   *  @param  uint32_t id
+   *
+   *  @return std::string
+   * */
+  std::string dictString(uint32_t id) const;
+  /**
+   *  @brief  Columns of the boot rows. The pointers point
+   *  into the mapped file and are valid while the reader lives.
+   *  They are NULL if the reader is not open.
+   *
+   *  @return const pointer to the first value of the column
+   * */
+  const uint32_t* bootDevice() const;
+  const int32_t* bootStartLine() const;
+  const int32_t* bootEndLine() const;
+  const int64_t* bootStartTime() const;
+  const int64_t* bootEndTime() const;
+  const int64_t* bootDurationMs() const;
+  /**
+   *  @brief  Columns of the service rows. The pointers point
+   *  into the mapped file and are valid while the reader lives.
+   *  They are NULL if the reader is not open.
+   *
+   *  @return const pointer to the first value of the column
+   * */
+  const uint32_t* serviceBoot() const;
+  const uint32_t* serviceId() const;
+  const int32_t* serviceStartLine() const;
+  const int32_t* serviceEndLine() const;
+  const int64_t* serviceDurationMs() const;
+
+ private:
+  // The reader owns the mapping, so it can not be copied
+  ColumnarReader(const ColumnarReader &);
+  ColumnarReader& operator=(const ColumnarReader &);
+  /**
+   *  @brief  Helper that returns the start of a column,
+   *  NULL if not open
+   *
+   *  @param  ColumnId column
+   *
+   *  @return const char*
+   * */
+  const char* column(ColumnId column) const;
+  /**
+   *  @brief  Helper that checks the header and that every
+   *  column fits inside the file
+   *
+   *  @return bool
+   * */
+  bool validate() const;
+
+  const char *data_;                //  < Start of the mapped file
+  std::size_t size_;                //  < Size of the mapped file
+  const ColumnarHeader *header_;    //  < Header at the start of the file
+};
+
+#endif  // PS4_KRONOS_COLUMNAR_HPP
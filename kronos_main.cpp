@@ -15,7 +15,11 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
 #include "kronos_parse_class.hpp"
+#include "kronos_columnar.hpp"
 
 using std::string;
 using boost::regex;
@@ -25,13 +29,124 @@ using boost::posix_time::ptime;
 using boost::posix_time::time_duration;
 using boost::posix_time::time_from_string;
 
+// Default cap on the length of a log line. Anything longer is skipped.
+const std::size_t DEFAULT_MAX_LINE_LENGTH = 4096;
+// Highest cap the user can ask for. The cap is what bounds the regex
+// work per line, so it can not be turned off with a huge number.
+const long MAX_LINE_LENGTH_LIMIT = 16384;
+
+/**
+ *  @brief  Read one line from the stream like getline, but never keep
+ *  more than max_length characters. The rest of an overlong line is
+ *  consumed and thrown away without buffering it, and the line comes
+ *  back empty with overlong set to true.
+ *
+ *  @param  std::istream& input, std::string& line,
+ *          std::size_t max_length, bool& overlong
+ *
+ *  @return bool
+ * */
+bool getBoundedLine(std::istream &input, std::string &line,
+                    std::size_t max_length, bool &overlong) {
+    std::streambuf *buffer = input.rdbuf();
+    bool read_any = false;
+    line.clear();
+    overlong = false;
+
+    while (true) {
+        int c = buffer->sbumpc();
+        if (c == std::char_traits<char>::eof()) {
+            // Same as getline: fail only if nothing was read
+            input.setstate(read_any ? std::ios::eofbit
+                                    : std::ios::eofbit | std::ios::failbit);
+            break;
+        }
+        read_any = true;
+        if (c == '\n') break;
+        if (line.size() < max_length)
+            line += static_cast<char>(c);
+        else
+            overlong = true;
+    }
+    if (overlong) line.clear();  // Never run the regex on a partial line
+    return read_any;
+}
+
+/**
+ *  @brief  Wrapper around regex_match that does not let a regex
+ *  error (like boost giving up on a too complex match) stop the run.
+ *  On error it sets error to true and reports no match. Once error
+ *  is set it does not try any other regex, so the rest of the line
+ *  is skipped. The regex only runs if the line has the literal text
+ *  the regex needs, which is a cheap linear check that keeps most
+ *  garbage lines away from the backtracking.
+ *
+ *  @param  const std::string& line, boost::smatch& m,
+ *          const boost::regex& re, const char* literal, bool& error
+ *
+ *  @return bool
+ * */
+bool safeMatch(const string &line, boost::smatch &m, const regex &re,
+               const char *literal, bool &error) {
+    if (error) return false;  // The line already failed, skip it
+    if (line.find(literal) == string::npos) return false;
+    try {
+        return regex_match(line, m, re);
+    } catch (const std::runtime_error &) {
+        error = true;
+        return false;
+    }
+}
+
+/**
+ *  @brief  Wrapper around time_from_string that does not let a
+ *  bad date (like month 13) stop the run. On error it returns
+ *  false and leaves time as it was.
+ *
+ *  @param  const std::string& text, boost::posix_time::ptime& time
+ *
+ *  @return bool
+ * */
+bool safeTime(const string &text, ptime &time) {
+    try {
+        time = time_from_string(text);
+        return true;
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
 int main(int argc, char **argv) {
-    if (argc < 2) {
-        std::cout << "ps4a [file name]" << std::endl;
+    // Split the --kcol option from the file name and line length
+    bool write_kcol = false;
+    std::vector<char*> args;
+    for (int a = 1; a < argc; ++a) {
+        if (string(argv[a]) == "--kcol")
+            write_kcol = true;
+        else
+            args.push_back(argv[a]);
+    }
+    if (args.size() < 1 || args.size() > 2) {
+        std::cout << "ps4b [--kcol] [file name] [max line length]"
+                  << std::endl;
         return -1;
     }
 
-    string f_name = argv[1];
+    std::size_t max_line_length = DEFAULT_MAX_LINE_LENGTH;
+    if (args.size() > 1) {
+        char *end_ptr = NULL;
+        errno = 0;
+        long arg = std::strtol(args[1], &end_ptr, 10);
+        if (errno != 0 || end_ptr == args[1] || *end_ptr != '\0' ||
+            arg <= 0 || arg > MAX_LINE_LENGTH_LIMIT) {
+            std::cout << "ps4b: max line length must be a number from 1 to "
+                      << MAX_LINE_LENGTH_LIMIT << std::endl;
+            return -1;
+        }
+        max_line_length = static_cast<std::size_t>(arg);
+    }
+
+    string f_name = args[0];
     ifstream input(f_name.c_str() );
     ofstream output((f_name + ".rpt").c_str());
 
@@ -43,8 +158,9 @@ int main(int argc, char **argv) {
 
     regex start_boot("([0-9]{4})-([0-9]{1,2})-([0-9]{1,2}) "
     "([0-9]{1,2}):([0-9]{1,2}):([0-9]{1,2}): \\(log.c.166\\) server started.*");
+    // [^:]*: finds the same colon as .*: did, without nesting two .*
     regex end_boot("([0-9]{4})-([0-9]{1,2})-([0-9]{1,2}) "
-    "([0-9]{1,2}):([0-9]{1,2}):([0-9]{1,2}).*"
+    "([0-9]{1,2}):([0-9]{1,2}):([0-9]{1,2})[^:]*"
     ":.*oejs.AbstractConnector:Started SelectChannelConnector.*");
 
     // My regex for the service boot and service started
@@ -52,6 +168,12 @@ int main(int argc, char **argv) {
     regex service_started("Service\\ started\\ successfully\\.\\ \\ "
                               "([a-zA-Z]+).+\\(([0-9]+).+");
 
+    // Literal text each regex needs, checked before running it
+    const char *start_text = ") server started";
+    const char *end_text = "AbstractConnector:Started SelectChannelConnector";
+    const char *service_boot_text = "Starting Service.  ";
+    const char *service_started_text = "Service started successfully.  ";
+
     int i = 1;
     string line, start, end;
     int num_of_boot = 0;
@@ -59,59 +181,103 @@ int main(int argc, char **argv) {
     boost::smatch m;
     int current_boot = 0;
     std::vector<Boot> vBoot;
+    bool overlong = false;
+    bool bad = false;            // True if a regex failed on this line
+    int num_of_overlong = 0;     // Lines skipped for being too long
+    int num_of_regex_errors = 0;  // Lines the regex engine gave up on
+    int num_of_bad_dates = 0;    // Lines skipped for an invalid date
+    int num_of_unknown = 0;      // Lines skipped for an unknown service
+    ptime s_time, e_time;
 
     // Parse input file line by line.
-    while (getline(input, line)) {
-        if ( regex_match(line, m, start_boot) && !visited_start ) {
+    while (getBoundedLine(input, line, max_line_length, overlong)) {
+        if (overlong) {
+            num_of_overlong++;
+            ++i;
+            continue;
+        }
+        bad = false;
+        if (safeMatch(line, m, start_boot, start_text, bad) &&
+            !visited_start) {
+            string date = m[1] + '-' + m[2] + '-' + m[3] + ' ';
+            date  += m[4] + ':'  + m[5] + ':'  + m[6];
+            if (!safeTime(date, s_time)) {  // Skip a boot with a bad date
+                num_of_bad_dates++;
+                ++i;
+                continue;
+            }
             visited_start = true;
             num_of_boot++;
-            start = m[1] + '-' + m[2] + '-' + m[3] + ' ';
-            start  += m[4] + ':'  + m[5] + ':'  + m[6];
+            start = date;
             // Here I create a new Boot and append it to the vector
             vBoot.push_back(Boot(f_name));
             // Here I set the information gotten of the start of the boot
             vBoot[current_boot].setFileName(f_name);
             vBoot[current_boot].setStartLine(i);
-            vBoot[current_boot].setStartTime(time_from_string(start));
+            vBoot[current_boot].setStartTime(s_time);
 
-        } else if (regex_match(line, m, end_boot) && visited_start) {
-            visited_start = false;
+        } else if (safeMatch(line, m, end_boot, end_text, bad) &&
+                   visited_start) {
             end = m[1] + '-' + m[2] + '-' + m[3] + ' ';
             end += m[4] + ':'  + m[5] + ':'  + m[6];
+            if (!safeTime(end, e_time)) {  // The boot stays open
+                num_of_bad_dates++;
+                ++i;
+                continue;
+            }
+            visited_start = false;
 
-            ptime s_time(time_from_string(start));
-            ptime e_time(time_from_string(end));
+            s_time = time_from_string(start);  // Already checked
             time_duration time_difference = e_time - s_time;
 
             // Here I am settings the information aobut the end of the boot
             vBoot[current_boot].setEndLine(i);
-            vBoot[current_boot].setEndTime(time_from_string(end));
+            vBoot[current_boot].setEndTime(e_time);
             vBoot[current_boot].setDuration(time_difference);
             vBoot[current_boot].completed();
             // Becuase the boot is complete, increment current boot
             current_boot++;
             num_of_completed++;  // Increment the completed variable
 
-        } else if (regex_match(line, m, start_boot) && visited_start) {
+        } else if (safeMatch(line, m, start_boot, start_text, bad) &&
+                   visited_start) {
+            string date = m[1] + '-' + m[2] + '-' + m[3] + ' ';
+            date  += m[4] + ':'  + m[5] + ':'  + m[6];
+            if (!safeTime(date, s_time)) {  // Skip a boot with a bad date
+                num_of_bad_dates++;
+                ++i;
+                continue;
+            }
             current_boot++;  // Found another boot
             num_of_boot++;  // Found another boot
-            start = m[1] + '-' + m[2] + '-' + m[3] + ' ';
-            start  += m[4] + ':'  + m[5] + ':'  + m[6];
+            start = date;
 
             // Here I create a new Boot and append it to the vector
             vBoot.push_back(Boot(f_name));
             // Here I set the information gotten of the start of the boot
             vBoot[current_boot].setFileName(f_name);
             vBoot[current_boot].setStartLine(i);
-            vBoot[current_boot].setStartTime(time_from_string(start));
-        } else if (regex_match(line, m, service_boot) && visited_start) {
+            vBoot[current_boot].setStartTime(s_time);
+        } else if (safeMatch(line, m, service_boot, service_boot_text, bad)
+                   && visited_start) {
+            if (!vBoot[current_boot].hasService(m[1])) {
+                num_of_unknown++;  // Not one of the known services
+                ++i;
+                continue;
+            }
             // Here I get the service by the name found in the log
             Service &service = vBoot[current_boot].getService(m[1]);
             // Change the state of the service to started
             service.started();
             // Set the start line
             service.setStartLine(i);
-        } else if (regex_match(line, m, service_started) && visited_start) {
+        } else if (safeMatch(line, m, service_started,
+                             service_started_text, bad) && visited_start) {
+            if (!vBoot[current_boot].hasService(m[1])) {
+                num_of_unknown++;  // Not one of the known services
+                ++i;
+                continue;
+            }
             // Here I get the service found in the log
             Service &service = vBoot[current_boot].getService(m[1]);
             // Set the duration
@@ -121,32 +287,22 @@ int main(int argc, char **argv) {
             // Set the line in which it was completed
             service.setEndLine(i);
         }
+        if (bad) num_of_regex_errors++;
         ++i;
     }
-    if (regex_match(line, m, start_boot) && visited_start) {
-        current_boot++;
-        num_of_boot++;
-        start = m[1] + '-' + m[2] + '-' + m[3] + ' ';
-        start  += m[4] + ':'  + m[5] + ':'  + m[6];
-
-        vBoot.push_back(Boot(f_name));
-        vBoot[current_boot].setFileName(f_name);
-        vBoot[current_boot].setStartLine(i);
-        vBoot[current_boot].setStartTime(time_from_string(start));
-    } else if (regex_match(line, m, service_boot) && visited_start) {
-        // Here I get the service by the name found in the log
-        Service &service = vBoot[current_boot].getService(m[1]);
-        // Change the state of the service to started
-        service.started();
-        // Set the start line
-        service.setStartLine(i);
-    }
 
     // Format the header of the put file
     std::stringstream ss;
     output << "Device Boot Report" << std::endl << std::endl
         << "InTouch log file: " << f_name << std::endl
-        << "Lines Scanned: " << i << std::endl << std::endl
+        << "Lines Scanned: " << i << std::endl
+        << "Lines skipped (longer than " << max_line_length << "): "
+        << num_of_overlong << std::endl
+        << "Lines skipped (regex error): " << num_of_regex_errors
+        << std::endl
+        << "Lines skipped (bad date): " << num_of_bad_dates << std::endl
+        << "Lines skipped (unknown service): " << num_of_unknown
+        << std::endl << std::endl
         << "Device boot count: initiated = " << num_of_boot
         << ", completed: " << num_of_completed << "\n\n\n";
 
@@ -156,5 +312,12 @@ int main(int argc, char **argv) {
 
     input.close();
     output.close();
+
+    // Same boots in the binary columnar format for analytics tools
+    if (write_kcol && !writeColumnar(f_name + ".kcol", vBoot)) {
+        std::cerr << "ps4b: could not write " << f_name << ".kcol"
+                  << std::endl;
+        return 1;
+    }
     return 0;
 }
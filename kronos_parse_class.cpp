@@ -8,6 +8,8 @@
  *  of the Boot and Services class.
  * */
 #include "kronos_parse_class.hpp"
+#include <cerrno>
+#include <cstdlib>
 #include <sstream>
 #include <utility>
 #include <map>
@@ -15,8 +17,8 @@
 #include <vector>
 
 Service::Service(std::string service_name, std::string file_name) :
-    name_(service_name), file_name_(file_name), completed_(false),
-    started_(false) {
+    name_(service_name), file_name_(file_name), duration_(-1),
+    completed_(false), started_(false) {
   // Initialize of the passed arguments
 }
 std::string Service::getName() const {
@@ -55,9 +57,12 @@ void Service::setEndLine(int end_line) {
 }
 std::string Service::getDuration() const {
   std::stringstream ss;
-  ss << duration_ << "ms";  // Add a suffix to the duration
+  ss << duration_text_ << "ms";  // Add a suffix to the duration
   return ss.str();
 }
+long Service::getDurationMs() const {
+  return duration_;
+}
 void Service::started() {
   started_ = true;
 }
@@ -65,7 +70,14 @@ void Service::completed() {
   completed_ = true;
 }
 void Service::setDuration(std::string duration) {
-  this->duration_ = duration;
+  this->duration_text_ = duration;
+  char *end_ptr = NULL;
+  errno = 0;
+  long value = std::strtol(duration.c_str(), &end_ptr, 10);
+  // Leave it as not set if it is not a number or too big for a long
+  if (errno != 0 || end_ptr == duration.c_str() || value < 0)
+    value = -1;
+  this->duration_ = value;
 }
 bool Service::isComplete() const {
   return completed_;
@@ -197,6 +209,9 @@ void Boot::setDate(boost::gregorian::date date) {
 Service& Boot::getService(std::string key) {
   return services_.at(key);  // Gets a services with a given key from the map
 }
+bool Boot::hasService(std::string key) const {
+  return services_.find(key) != services_.end();
+}
 boost::posix_time::ptime Boot::getStartTime() const {
   return start_time_;
 }
@@ -88,9 +88,17 @@ class Service {
    * */
   std::string getDuration() const;
   /**
-   *  @breif  Setter for the duration. It is a string
-   *  because it appear in the log file, so there is
-   *  nothing to calculate.
+   *  @breif  Getter for the duration in milliseconds.
+   *  It is -1 if the duration was never set or did not
+   *  fit in a long.
+   *
+   *  @return long
+   * */
+  long getDurationMs() const;
+  /**
+   *  @breif  Setter for the duration. It takes the string
+   *  as it appear in the log file, keeps it for the report
+   *  and stores it as a number of milliseconds.
    *
    *  @param  std::string duration
    * */
@@ -125,7 +133,8 @@ class Service {
   std::string file_name_;   //  < Name of the file
   int start_line_;          //  < Start line of the service
   int end_line_;            //  < End line of the service
-  std::string duration_;    //  < Duration of service to start
+  long duration_;           //  < Duration of service to start in ms
+  std::string duration_text_;  //  < Duration as written in the log
   bool completed_;          //  < True if the service is completed
   bool started_;            //  < True if the service started
 };
@@ -281,6 +290,16 @@ class Boot {
    *  @return Service&
    * */
   Service& getService(std::string service_name);
+  /**
+   *  @brief  Check if a service with the given name is in
+   *  the map. Use it before getService() with names that come
+   *  from the log, getService() throws on unknown names.
+   *
+   *  @param  std::string service_name
+   *
+   *  @return bool
+   * */
+  bool hasService(std::string service_name) const;
   /**
    *  @brief  This return a iterator to the begin of the map
    *